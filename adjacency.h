@@ -0,0 +1,153 @@
+
+#ifndef AIRLINE_ROUTING_ADJACENCY_H
+#define AIRLINE_ROUTING_ADJACENCY_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <mutex>
+
+using std::string;
+using std::unordered_map;
+using std::vector;
+using std::tuple;
+using std::get;
+
+// Compressed sparse row edge list
+// Edges of vertex i are stored at indices offsets[i] up to (but not including) offsets[i + 1]
+struct Csr {
+    vector<int> offsets;  // start of each vertex's edges, one extra entry marks the end
+    vector<int> targets;  // vertex index at the other end of each edge
+    vector<int> distance; // distance weight of each edge
+    vector<int> cost;     // cost weight of each edge
+};
+
+// Integer indexed snapshot of the flight network
+// Stores the forward adjacency (departures) and the reverse adjacency (arrivals) of every airport
+class Adjacency {
+private:
+    vector<string> codes; // Vertex index is position, IATA code is value
+    unordered_map<string, int> indexes; // IATA code is key, vertex index is value
+    Csr forward; // Edges point from departure to arrival
+    Csr reverse; // Edges point from arrival back to departure
+
+    // Fills a CSR from (from index, to index, distance, cost) tuples
+    void build(Csr& csr, const vector<tuple<int, int, int, int>>& edges) {
+        csr.offsets.assign(codes.size() + 1, 0);
+        csr.targets.resize(edges.size());
+        csr.distance.resize(edges.size());
+        csr.cost.resize(edges.size());
+        // Count edges per vertex, then prefix sum into starting offsets
+        for (const auto& edge: edges) {
+            csr.offsets[get<0>(edge) + 1]++;
+        }
+        for (size_t i = 1; i < csr.offsets.size(); i++) {
+            csr.offsets[i] += csr.offsets[i - 1];
+        }
+        // Place each edge at the next free slot of its vertex
+        vector<int> next(csr.offsets.begin(), csr.offsets.end() - 1);
+        for (const auto& edge: edges) {
+            int slot = next[get<0>(edge)]++;
+            csr.targets[slot] = get<1>(edge);
+            csr.distance[slot] = get<2>(edge);
+            csr.cost[slot] = get<3>(edge);
+        }
+    }
+
+public:
+    Adjacency() = default;
+
+    // Builds both adjacencies from airport codes and (depart code, arrive code, distance, cost) flights
+    // Codes are indexed in sorted order so indexes do not depend on hash map ordering
+    Adjacency(vector<string> airports, const vector<tuple<string, string, int, int>>& flights)
+            : codes(std::move(airports)) {
+        std::sort(codes.begin(), codes.end());
+        for (size_t i = 0; i < codes.size(); i++) {
+            indexes.insert({codes[i], static_cast<int>(i)});
+        }
+        vector<tuple<int, int, int, int>> out, in;
+        out.reserve(flights.size());
+        in.reserve(flights.size());
+        for (const auto& flight: flights) {
+            int from = indexes.at(get<0>(flight));
+            int to = indexes.at(get<1>(flight));
+            out.emplace_back(from, to, get<2>(flight), get<3>(flight));
+            in.emplace_back(to, from, get<2>(flight), get<3>(flight));
+        }
+        build(forward, out);
+        build(reverse, in);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return codes.size();
+    }
+
+    [[nodiscard]] const Csr& get_forward() const {
+        return forward;
+    }
+
+    [[nodiscard]] const Csr& get_reverse() const {
+        return reverse;
+    }
+
+    // Returns the vertex index of an IATA code
+    [[nodiscard]] int index_of(const string& code) const {
+        return indexes.at(code);
+    }
+
+    // Returns the IATA code of a vertex index
+    [[nodiscard]] const string& code_of(int index) const {
+        return codes[index];
+    }
+};
+
+// Lazily built Adjacency shared by const readers
+// Rebuilds under a lock so concurrent searches on one graph see a single consistent snapshot
+class AdjacencyCache {
+private:
+    mutable std::mutex lock;
+    mutable Adjacency adjacency;
+    mutable bool stale = true;
+
+public:
+    AdjacencyCache() = default;
+
+    // Copies the snapshot, each copy gets its own lock
+    AdjacencyCache(const AdjacencyCache& other) {
+        std::lock_guard<std::mutex> guard(other.lock);
+        adjacency = other.adjacency;
+        stale = other.stale;
+    }
+
+    AdjacencyCache& operator=(const AdjacencyCache& other) {
+        if (this == &other) return *this;
+        std::lock(lock, other.lock);
+        std::lock_guard<std::mutex> guard(lock, std::adopt_lock);
+        std::lock_guard<std::mutex> guard_other(other.lock, std::adopt_lock);
+        adjacency = other.adjacency;
+        stale = other.stale;
+        return *this;
+    }
+
+    // Marks the snapshot out of date, called whenever the graph changes
+    void invalidate() {
+        std::lock_guard<std::mutex> guard(lock);
+        stale = true;
+    }
+
+    // Returns the snapshot, calling build() to replace it first if it is out of date
+    template<typename Build>
+    const Adjacency& get(Build build) const {
+        std::lock_guard<std::mutex> guard(lock);
+        if (stale) {
+            adjacency = build();
+            stale = false;
+        }
+        return adjacency;
+    }
+};
+
+#endif
@@ -0,0 +1,516 @@
+
+#ifndef AIRLINE_ROUTING_APSP_H
+#define AIRLINE_ROUTING_APSP_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include "graph.h"
+#include "adjacency.h"
+#include "pathing.h"
+#include "util.h"
+
+using std::string;
+using std::vector;
+using std::unordered_map;
+
+const size_t APSP_TILE = 64;            // tile edge length for blocked Floyd-Warshall, three int tiles fit in L2
+const int UNREACHABLE = INF / 2;        // table sentinel, half of INF so two of them can be added without overflow
+
+// Runs f(0) through f(count - 1) spread over up to 'threads' threads
+// Items are handed out one at a time so uneven items still balance
+template<typename Function>
+void parallel_for(size_t count, unsigned threads, Function f) {
+    if (count == 0) return;
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, count)));
+    std::atomic<size_t> next_item(0);
+    auto worker = [&]() {
+        for (size_t i = next_item++; i < count; i = next_item++) {
+            f(i);
+        }
+    };
+    vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();  // calling thread works too
+    for (auto& thread: pool) {
+        thread.join();
+    }
+}
+
+// Algorithm used to fill a PathTable
+enum class ApspMethod {
+    Auto,           // Dijkstra for sparse graphs, Floyd-Warshall for dense ones
+    FloydWarshall,  // cache blocked Floyd-Warshall, tiles of each phase run in parallel
+    Dijkstra        // one Dijkstra search per origin, origins run in parallel
+};
+
+// All pairs shortest path table
+// Stores distance, cost, and next hop for every (origin, destination) pair as row major matrices
+// Once built, route queries are table lookups instead of searches
+class PathTable {
+private:
+    vector<string> codes; // Vertex index is position, IATA code is value
+    unordered_map<string, int> indexes; // IATA code is key, vertex index is value
+    vector<std::pair<string, vector<int>>> by_state; // State abbreviation and vertex indexes of its airports, in graph order
+    size_t stride = 0; // Row length of each matrix, vertex count rounded up to a whole tile
+    vector<int> dist; // dist[i * stride + j] is the shortest distance from i to j, UNREACHABLE if none
+    vector<int> cost; // cost[i * stride + j] is the cost along that shortest path
+    vector<int> next; // next[i * stride + j] is the first hop from i toward j, -1 if none
+
+    // Sizes the matrices and fills them with direct flights only
+    void init(const Adjacency& adj) {
+        size_t n = adj.size();
+        stride = (n + APSP_TILE - 1) / APSP_TILE * APSP_TILE;
+        if (stride == 0) stride = APSP_TILE;
+        dist.assign(stride * stride, UNREACHABLE);
+        cost.assign(stride * stride, UNREACHABLE);
+        next.assign(stride * stride, -1);
+        for (size_t i = 0; i < stride; i++) {
+            dist[i * stride + i] = 0;
+            cost[i * stride + i] = 0;
+            next[i * stride + i] = static_cast<int>(i);
+        }
+        const Csr& csr = adj.get_forward();
+        for (size_t i = 0; i < n; i++) {
+            for (int e = csr.offsets[i]; e < csr.offsets[i + 1]; e++) {
+                size_t at = i * stride + csr.targets[e];
+                if (csr.distance[e] < dist[at]) {
+                    dist[at] = csr.distance[e];
+                    cost[at] = csr.cost[e];
+                    next[at] = csr.targets[e];
+                }
+            }
+        }
+    }
+
+    // Relaxes one tile wide stretch of row i through vertex k, given row i's distance and first hop to k
+    // Branch free with non overlapping rows and a fixed trip count, so the compiler vectorizes it with compare and blend
+    static void relax_row(int* __restrict di, int* __restrict ni, const int* __restrict dk, int dik, int nik) {
+        for (size_t j = 0; j < APSP_TILE; j++) {
+            int d = dik + dk[j];
+            bool better = d < di[j];
+            di[j] = better ? d : di[j];
+            ni[j] = better ? nik : ni[j];
+        }
+    }
+
+    // Relaxes every pair in tile (bi, bj) through each intermediate vertex of block bk
+    void relax_tile(size_t bi, size_t bj, size_t bk) {
+        size_t col = bj * APSP_TILE;
+        for (size_t k = bk * APSP_TILE; k < (bk + 1) * APSP_TILE; k++) {
+            for (size_t i = bi * APSP_TILE; i < (bi + 1) * APSP_TILE; i++) {
+                if (i == k) continue;  // row k only relaxes through itself at distance 0, and skipping it keeps di apart from dk
+                int dik = dist[i * stride + k];
+                if (dik >= UNREACHABLE) continue;  // nothing to gain through k
+                relax_row(&dist[i * stride + col], &next[i * stride + col], &dist[k * stride + col],
+                          dik, next[i * stride + k]);
+            }
+        }
+    }
+
+    // Fills cost along the route next[] describes for every pair, one destination column per item
+    // Cost is not carried through relaxation since equal distance routes can differ in cost
+    void fill_costs(unsigned threads) {
+        size_t n = codes.size();
+        const vector<int> edge = cost;  // direct flight costs from init
+        parallel_for(n, threads, [&](size_t j) {
+            vector<bool> done(n, false);
+            vector<size_t> chain;
+            done[j] = true;
+            for (size_t i = 0; i < n; i++) {
+                // Walk toward j until reaching an airport whose cost is known or that cannot reach j
+                size_t v = i;
+                while (!done[v] && next[v * stride + j] != -1) {
+                    chain.push_back(v);
+                    v = static_cast<size_t>(next[v * stride + j]);
+                }
+                done[v] = true;
+                while (!chain.empty()) {
+                    size_t u = chain.back();
+                    chain.pop_back();
+                    auto hop = static_cast<size_t>(next[u * stride + j]);
+                    cost[u * stride + j] = edge[u * stride + hop] + cost[hop * stride + j];
+                    done[u] = true;
+                }
+            }
+        });
+    }
+
+    // Blocked Floyd-Warshall
+    // For each block k: the diagonal tile first, then the rest of row and column k, then every other tile
+    void floyd_warshall(unsigned threads) {
+        size_t blocks = stride / APSP_TILE;
+        for (size_t k = 0; k < blocks; k++) {
+            relax_tile(k, k, k);
+            // Row k and column k tiles only depend on the diagonal tile
+            parallel_for(2 * (blocks - 1), threads, [&](size_t t) {
+                size_t other = t / 2;
+                if (other >= k) other++;
+                if (t % 2 == 0) {
+                    relax_tile(k, other, k);
+                } else {
+                    relax_tile(other, k, k);
+                }
+            });
+            // Remaining tiles only depend on row k and column k
+            parallel_for((blocks - 1) * (blocks - 1), threads, [&](size_t t) {
+                size_t i = t / (blocks - 1);
+                size_t j = t % (blocks - 1);
+                if (i >= k) i++;
+                if (j >= k) j++;
+                relax_tile(i, j, k);
+            });
+        }
+    }
+
+    // One Dijkstra search per origin, each writing only its own matrix rows
+    void dijkstra(const Adjacency& adj, unsigned threads) {
+        size_t n = adj.size();
+        parallel_for(n, threads, [&](size_t i) {
+            SearchTree t = shortest_path_tree(adj.get_forward(), static_cast<int>(i));
+            int* ni = &next[i * stride];
+            for (size_t j = 0; j < n; j++) {
+                ni[j] = j == i ? static_cast<int>(i) : -1;  // direct flights from init may not be shortest
+                if (t.dist[j] == INF) continue;
+                dist[i * stride + j] = t.dist[j];
+                cost[i * stride + j] = t.cost[j];
+            }
+            // First hop toward j is the first hop toward its parent, unless the parent is the origin
+            vector<int> chain;
+            for (size_t j = 0; j < n; j++) {
+                int v = static_cast<int>(j);
+                while (v != static_cast<int>(i) && t.parent[v] != -1 && ni[v] == -1) {
+                    chain.push_back(v);
+                    v = t.parent[v];
+                }
+                while (!chain.empty()) {
+                    int u = chain.back();
+                    chain.pop_back();
+                    ni[u] = t.parent[u] == static_cast<int>(i) ? u : ni[t.parent[u]];
+                }
+            }
+        });
+    }
+
+    [[nodiscard]] size_t at(const string& from, const string& to) const {
+        return indexes.at(from) * stride + indexes.at(to);
+    }
+
+    // Writes a fixed width value in host byte order
+    template<typename T>
+    static void write_raw(std::ostream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Reads a fixed width value in host byte order
+    template<typename T>
+    static T read_raw(std::istream& in) {
+        T value;
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        if (!in) throw std::runtime_error("Truncated path table");
+        return value;
+    }
+
+    static void write_string(std::ostream& out, const string& s) {
+        write_raw<uint8_t>(out, static_cast<uint8_t>(s.size()));
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    static string read_string(std::istream& in) {
+        string s(read_raw<uint8_t>(in), '\0');
+        in.read(&s[0], static_cast<std::streamsize>(s.size()));
+        if (!in) throw std::runtime_error("Truncated path table");
+        return s;
+    }
+
+    PathTable() = default;
+
+public:
+    // Results from a single origin, with the same printing interface as Paths
+    // Unlike Paths it refers to its table rather than owning a copy, so it must not outlive the table
+    class Origin {
+    private:
+        const PathTable& table;
+        string from;
+
+    public:
+        Origin(const PathTable& table, string from) : table(table), from(std::move(from)) {}
+
+        // Print the single shortest path to the given airport code
+        void to(const string& to) const {
+            vector<string> path = table.route(from, to);
+            if (path.size() < 2) {
+                std::cout << "Shortest route from " << from << " to " << to << ": None" << std::endl;
+                return;
+            }
+            std::cout << "Shortest route from " << from << " to " << to << ": ";
+            Path::print_path(path);
+            std::cout << ". The length is " << table.distance(from, to) << ". The cost is " << table.cost_of(from, to)
+                      << "." << std::endl;
+        }
+
+        // Print all shortest paths from origin to airports in the given state code
+        unordered_map<string, Path> to_state(const string& to) const {
+            unordered_map<string, Path> out;
+            std::cout << "The shortest paths from " << from << " to " << to << " state airports are:" << std::endl;
+            std::cout << std::endl << "Path\tLength\tCost" << std::endl;
+            for (const auto& state: table.by_state) {
+                if (state.first != to) continue;
+                for (int index: state.second) {
+                    const string& code = table.codes[index];
+                    Path p;
+                    p.path = table.route(from, code);
+                    if (p.path.size() < 2) continue;  // skip unreachable airports and the origin itself
+                    p.distance = table.distance(from, code);
+                    p.cost = table.cost_of(from, code);
+                    p.print_path();
+                    std::cout << "\t" << p.distance << "\t" << p.cost << std::endl;
+                    out.insert({code, p});
+                }
+            }
+            return out;
+        }
+    };
+
+    // Builds the table for every airport in g
+    // Auto uses Dijkstra when the graph has fewer than a quarter of all possible flights
+    static PathTable build(const Graph& g, ApspMethod method = ApspMethod::Auto,
+                           unsigned threads = std::thread::hardware_concurrency()) {
+        PathTable table;
+        const Adjacency& adj = g.get_adjacency();
+        size_t n = adj.size();
+        for (size_t i = 0; i < n; i++) {
+            table.codes.push_back(adj.code_of(static_cast<int>(i)));
+            table.indexes.insert({table.codes.back(), static_cast<int>(i)});
+        }
+        for (const auto& state: g.get_states()) {
+            vector<int> members;
+            for (const Airport* airport: state.second) {
+                members.push_back(adj.index_of(airport->get_code()));
+            }
+            table.by_state.emplace_back(state.first, members);
+        }
+        table.init(adj);
+        if (threads == 0) threads = 1;
+        if (method == ApspMethod::Auto) {
+            size_t edges = adj.get_forward().targets.size();
+            method = edges * 4 < n * n ? ApspMethod::Dijkstra : ApspMethod::FloydWarshall;
+        }
+        if (method == ApspMethod::FloydWarshall) {
+            table.floyd_warshall(threads);
+            table.fill_costs(threads);
+        } else {
+            table.dijkstra(adj, threads);
+        }
+        return table;
+    }
+
+    // Throws if following next[] from any airport toward any destination does not end at that destination
+    // Same walk as fill_costs, but a revisit within one walk means a cycle
+    void check_routes() const {
+        size_t n = codes.size();
+        vector<char> state(n);  // 0 unchecked, 1 on the current walk, 2 known to reach the destination
+        vector<size_t> chain;
+        for (size_t j = 0; j < n; j++) {
+            std::fill(state.begin(), state.end(), 0);
+            state[j] = 2;
+            for (size_t i = 0; i < n; i++) {
+                size_t v = i;
+                while (state[v] == 0 && next[v * stride + j] != -1) {
+                    state[v] = 1;
+                    chain.push_back(v);
+                    v = static_cast<size_t>(next[v * stride + j]);
+                }
+                if (state[v] == 1 || (state[v] == 0 && !chain.empty())) {
+                    throw std::runtime_error("Corrupt path table: route from " + codes[i] + " to " + codes[j]
+                                             + " does not arrive");
+                }
+                for (size_t u: chain) {
+                    state[u] = 2;
+                }
+                chain.clear();
+            }
+        }
+    }
+
+    // Loads a table written by save
+    // Throws std::runtime_error if the file is missing, truncated, has trailing bytes, is not a path table,
+    // or holds an index, distance, or route that could not have come from save
+    static PathTable load(const string& filename) {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot open path table " + filename);
+        in.seekg(0, std::ios::end);
+        auto file_size = static_cast<uint64_t>(in.tellg());
+        in.seekg(0, std::ios::beg);
+        if (read_raw<uint32_t>(in) != 0x50535041 || read_raw<uint32_t>(in) != 1) {  // "APSP", version 1
+            throw std::runtime_error("Not a path table: " + filename);
+        }
+        PathTable table;
+        auto n = read_raw<uint32_t>(in);
+        // Every code takes at least one byte, so a larger count cannot be genuine
+        if (n > file_size) throw std::runtime_error("Corrupt path table: airport count " + std::to_string(n));
+        for (uint32_t i = 0; i < n; i++) {
+            table.codes.push_back(read_string(in));
+            if (!table.indexes.insert({table.codes.back(), static_cast<int>(i)}).second) {
+                throw std::runtime_error("Corrupt path table: duplicate airport " + table.codes.back());
+            }
+        }
+        auto states = read_raw<uint32_t>(in);
+        if (states > n) throw std::runtime_error("Corrupt path table: state count " + std::to_string(states));
+        for (uint32_t s = 0; s < states; s++) {
+            string state = read_string(in);
+            auto count = read_raw<uint32_t>(in);
+            if (count > n) throw std::runtime_error("Corrupt path table: airport count for " + state);
+            vector<int> members(count);
+            for (int& member: members) {
+                auto index = read_raw<uint32_t>(in);
+                if (index >= n) throw std::runtime_error("Corrupt path table: airport index in " + state);
+                member = static_cast<int>(index);
+            }
+            table.by_state.emplace_back(state, members);
+        }
+        // The rest of the file must be exactly the matrices, checked before allocating them
+        bool narrow = n < 0xFFFF;
+        uint64_t expected = static_cast<uint64_t>(n) * n * (2 * sizeof(int32_t) + (narrow ? sizeof(uint16_t) : sizeof(int32_t)));
+        if (file_size - static_cast<uint64_t>(in.tellg()) != expected) {
+            throw std::runtime_error("Corrupt path table: matrix size does not match " + std::to_string(n) + " airports");
+        }
+        table.stride = (n + APSP_TILE - 1) / APSP_TILE * APSP_TILE;
+        if (table.stride == 0) table.stride = APSP_TILE;
+        table.dist.assign(table.stride * table.stride, UNREACHABLE);
+        table.cost.assign(table.stride * table.stride, UNREACHABLE);
+        table.next.assign(table.stride * table.stride, -1);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                size_t at = i * table.stride + j;
+                int d = read_raw<int32_t>(in);
+                int c = read_raw<int32_t>(in);
+                int hop;
+                if (narrow) {
+                    auto raw = read_raw<uint16_t>(in);
+                    hop = raw == 0xFFFF ? -1 : raw;
+                } else {
+                    hop = read_raw<int32_t>(in);
+                }
+                // Hop must be a real airport, only unreachable pairs have none, and each airport reaches itself
+                bool valid = hop >= -1 && hop < static_cast<int>(n)
+                             && d >= 0 && d <= UNREACHABLE
+                             && (hop == -1) == (d == UNREACHABLE)
+                             && (i != j || (hop == static_cast<int>(i) && d == 0));
+                if (!valid) {
+                    throw std::runtime_error("Corrupt path table: entry from " + table.codes[i] + " to " + table.codes[j]);
+                }
+                table.dist[at] = d;
+                table.cost[at] = c;
+                table.next[at] = hop;
+            }
+        }
+        table.check_routes();
+        return table;
+    }
+
+    // Writes the table as: magic, version, codes, states, then (distance, cost, next hop) for every pair
+    // Padding is not stored and next hops are 16 bit when there are fewer than 65535 airports
+    void save(const string& filename) const {
+        std::ofstream out(filename, std::ios::binary);
+        if (!out) throw std::runtime_error("Cannot write path table " + filename);
+        write_raw<uint32_t>(out, 0x50535041);
+        write_raw<uint32_t>(out, 1);
+        write_raw<uint32_t>(out, static_cast<uint32_t>(codes.size()));
+        for (const string& code: codes) {
+            write_string(out, code);
+        }
+        write_raw<uint32_t>(out, static_cast<uint32_t>(by_state.size()));
+        for (const auto& state: by_state) {
+            write_string(out, state.first);
+            write_raw<uint32_t>(out, static_cast<uint32_t>(state.second.size()));
+            for (int member: state.second) {
+                write_raw<uint32_t>(out, static_cast<uint32_t>(member));
+            }
+        }
+        bool narrow = codes.size() < 0xFFFF;
+        for (size_t i = 0; i < codes.size(); i++) {
+            for (size_t j = 0; j < codes.size(); j++) {
+                size_t at = i * stride + j;
+                write_raw<int32_t>(out, dist[at]);
+                write_raw<int32_t>(out, cost[at]);
+                if (narrow) {
+                    write_raw<uint16_t>(out, next[at] == -1 ? 0xFFFF : static_cast<uint16_t>(next[at]));
+                } else {
+                    write_raw<int32_t>(out, next[at]);
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] size_t size() const {
+        return codes.size();
+    }
+
+    // Returns the shortest distance between two airports, INF if unreachable
+    [[nodiscard]] int distance(const string& from, const string& to) const {
+        int d = dist[at(from, to)];
+        return d >= UNREACHABLE ? INF : d;
+    }
+
+    // Returns the cost along the shortest path between two airports, INF if unreachable
+    [[nodiscard]] int cost_of(const string& from, const string& to) const {
+        size_t i = at(from, to);
+        return dist[i] >= UNREACHABLE ? INF : cost[i];
+    }
+
+    // Returns the airport codes along the shortest path, empty if unreachable
+    [[nodiscard]] vector<string> route(const string& from, const string& to) const {
+        vector<string> path;
+        int u = indexes.at(from);
+        int v = indexes.at(to);
+        if (next[u * stride + v] == -1) return path;
+        path.push_back(codes[u]);
+        while (u != v) {
+            u = next[u * stride + v];
+            path.push_back(codes[u]);
+        }
+        return path;
+    }
+
+    // Returns results from one origin, used like find_paths_from(g, from)
+    // Origin refers back to this table, so it is only available on a table that outlives it
+    [[nodiscard]] Origin from(const string& from) const & {
+        indexes.at(from);  // throw now rather than on first query
+        return {*this, from};
+    }
+
+    // A temporary table would be destroyed before the returned Origin is used
+    Origin from(const string& from) const && = delete;
+
+    // Number of other airports reachable from the given airport
+    [[nodiscard]] int reachable_from(const string& from) const {
+        size_t i = indexes.at(from);
+        int count = 0;
+        for (size_t j = 0; j < codes.size(); j++) {
+            count += (j != i && dist[i * stride + j] < UNREACHABLE);
+        }
+        return count;
+    }
+
+    // Number of other airports that can reach the given airport
+    [[nodiscard]] int reachable_to(const string& to) const {
+        size_t j = indexes.at(to);
+        int count = 0;
+        for (size_t i = 0; i < codes.size(); i++) {
+            count += (i != j && dist[i * stride + j] < UNREACHABLE);
+        }
+        return count;
+    }
+};
+
+#endif  // AIRLINE_ROUTING_APSP_H
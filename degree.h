@@ -0,0 +1,158 @@
+
+#ifndef AIRLINE_ROUTING_DEGREE_H
+#define AIRLINE_ROUTING_DEGREE_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <set>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include "util.h"
+
+using std::string;
+using std::unordered_map;
+using std::vector;
+using std::pair;
+
+// Incoming, outgoing, and total flight counts for every airport
+// Kept up to date as airports and flights are added so rankings never require a full sort
+class DegreeIndex {
+public:
+    // Flight counts for a single airport
+    struct Degree {
+        string code;
+        string state;
+        int incoming;
+        int outgoing;
+
+        Degree(string code, string state) : code(std::move(code)), state(std::move(state)), incoming(0), outgoing(0) {}
+
+        [[nodiscard]] int total() const {
+            return incoming + outgoing;
+        }
+    };
+
+    // Flight counts summed over every airport in a state
+    struct StateDegree {
+        int airports;
+        int incoming;
+        int outgoing;
+
+        StateDegree() : airports(0), incoming(0), outgoing(0) {}
+
+        [[nodiscard]] int total() const {
+            return incoming + outgoing;
+        }
+    };
+
+private:
+    unordered_map<string, Degree> degrees; // IATA code is key, counts for that airport are value
+    std::set<pair<int, string>> ranking; // (negated total, IATA code) so iteration runs from most to least connected
+    std::map<int, int> frequency; // Total connections is key, number of airports with that total is value
+    unordered_map<string, StateDegree> by_state; // State abbreviation is key, summed counts are value
+
+    // Moves an airport to its new position in the ranking and frequency table
+    void update(Degree& d, int d_incoming, int d_outgoing) {
+        int old_total = d.total();
+        ranking.erase({-old_total, d.code});
+        if (--frequency[old_total] == 0) {
+            frequency.erase(old_total);
+        }
+        d.incoming += d_incoming;
+        d.outgoing += d_outgoing;
+        ranking.insert({-d.total(), d.code});
+        frequency[d.total()]++;
+        StateDegree& s = by_state[d.state];
+        s.incoming += d_incoming;
+        s.outgoing += d_outgoing;
+    }
+
+public:
+    DegreeIndex() = default;
+
+    [[nodiscard]] size_t size() const {
+        return degrees.size();
+    }
+
+    // Registers a new airport with no flights
+    // Duplicate airports are ignored
+    void add_airport(const string& code, const string& state) {
+        if (contains(degrees, code)) return;
+        degrees.insert({code, Degree(code, state)});
+        ranking.insert({0, code});
+        frequency[0]++;
+        by_state[state].airports++;
+    }
+
+    // Counts a flight against both of its airports
+    // Assumes both codes have already been registered
+    void add_flight(const string& code_depart, const string& code_arrive) {
+        update(degrees.at(code_depart), 0, 1);
+        update(degrees.at(code_arrive), 1, 0);
+    }
+
+    // Returns the counts for a single airport
+    [[nodiscard]] const Degree& at(const string& code) const {
+        return degrees.at(code);
+    }
+
+    // Returns the k most connected airports in descending order, ties broken by IATA code
+    // O(k) since the ranking is already ordered
+    [[nodiscard]] vector<Degree> top(size_t k) const {
+        vector<Degree> v;
+        v.reserve(std::min(k, ranking.size()));
+        for (auto it = ranking.begin(); it != ranking.end() && v.size() < k; ++it) {
+            v.push_back(degrees.at(it->second));
+        }
+        return v;
+    }
+
+    // Returns the total connections at the given percentile (0-100) using the nearest-rank method
+    // Returns 0 if there are no airports
+    [[nodiscard]] int percentile(double p) const {
+        if (degrees.empty()) return 0;
+        p = std::max(0.0, std::min(100.0, p));
+        // Rank of the requested airport counting from the least connected, at least 1
+        auto rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(degrees.size())));
+        rank = std::max<size_t>(rank, 1);
+        size_t seen = 0;
+        // Walk distinct totals from smallest to largest until the rank is covered
+        for (const auto& bucket: frequency) {
+            seen += bucket.second;
+            if (seen >= rank) {
+                return bucket.first;
+            }
+        }
+        return frequency.rbegin()->first;
+    }
+
+    // Returns (bucket start, number of airports) pairs for buckets of the given width
+    // Empty buckets are omitted
+    [[nodiscard]] vector<pair<int, int>> histogram(int bucket_width) const {
+        vector<pair<int, int>> v;
+        if (bucket_width < 1) bucket_width = 1;
+        for (const auto& bucket: frequency) {
+            int start = bucket.first / bucket_width * bucket_width;
+            if (v.empty() || v.back().first != start) {
+                v.emplace_back(start, 0);
+            }
+            v.back().second += bucket.second;
+        }
+        return v;
+    }
+
+    // Returns summed counts for every state
+    [[nodiscard]] const unordered_map<string, StateDegree>& get_states() const {
+        return by_state;
+    }
+
+    // Returns summed counts for a single state
+    [[nodiscard]] const StateDegree& state(const string& state) const {
+        return by_state.at(state);
+    }
+};
+
+#endif
@@ -12,6 +12,8 @@
 #include <sstream>
 #include <algorithm>
 #include "util.h"
+#include "degree.h"
+#include "adjacency.h"
 
 using std::string;
 using std::exception;
@@ -47,16 +49,15 @@ public:
 };
 
 // Vertex of graph
-// Stores map of edges, number of incoming and outgoing flights, IATA code, and state abbreviation
+// Stores map of edges, IATA code, and state abbreviation
+// Flight counts live in Graph's DegreeIndex
 class Airport {
 private:
     unordered_map<string, Flight*> edges; // IATA code is key, pointer to Flight is value
-    int incoming;
-    int outgoing;
     string code;
     string state;
 public:
-    Airport(string code, string state) : code(std::move(code)), state(std::move(state)), incoming(0), outgoing(0) {}
+    Airport(string code, string state) : code(std::move(code)), state(std::move(state)) {}
 
     [[nodiscard]] unordered_map<string, Flight*> get_edges() const {
         return edges;
@@ -77,18 +78,6 @@ public:
     bool is_terminal() {
         return edges.empty();
     }
-
-    void inc_incoming() {
-        incoming++;
-    }
-
-    void inc_outgoing() {
-        outgoing++;
-    }
-
-    int total_flights() {
-        return incoming + outgoing;
-    }
 };
 
 // If the destination of this flight has no departing flights
@@ -102,11 +91,13 @@ string get_state_code(const string& city) {
 }
 
 // Primary data structure for the application
-// Stores a map of all airports and all airports in each state.
+// Stores a map of all airports, all airports in each state, and flight counts for each airport.
 class Graph {
 private:
     unordered_map<string, vector<Airport*>> by_state; // State abbreviation is key, vector of pointers to airports in said state is value
     unordered_map<string, Airport*> vertexes; // IATA code is key, pointer to airport is value
+    DegreeIndex degrees; // Incoming and outgoing flight counts, updated by add_airport and add_flight
+    AdjacencyCache adjacency; // Forward and reverse CSR snapshot, rebuilt on first use after the graph changes
 public:
     Graph() = default;
 
@@ -155,6 +146,25 @@ public:
         return by_state;
     }
 
+    [[nodiscard]] const DegreeIndex& get_degrees() const {
+        return degrees;
+    }
+
+    // Returns the forward and reverse adjacency of the current graph
+    // Rebuilt only if airports or flights were added since the last call
+    // Safe to call from several threads at once as long as none of them modify the graph
+    [[nodiscard]] const Adjacency& get_adjacency() const {
+        return adjacency.get([this]() {
+            vector<tuple<string, string, int, int>> flights;
+            for (const auto& vertex: vertexes) {
+                for (const auto& edge: vertex.second->get_edges()) {
+                    flights.emplace_back(vertex.first, edge.first, edge.second->get_distance(), edge.second->get_cost());
+                }
+            }
+            return Adjacency(get_all_airports(), flights);
+        });
+    }
+
     // Returns a vector of all IATA codes
     [[nodiscard]] vector<string> get_all_airports() const {
         vector<string> v;
@@ -184,6 +194,8 @@ public:
         auto ap = new Airport(code, state);
         // Insert will not overwrite duplicate airports
         vertexes.insert({code, ap});
+        degrees.add_airport(code, state);
+        adjacency.invalidate();
         // If state is new create it
         if (!contains(by_state,state)) {
             by_state.insert({state, {ap}});
@@ -197,9 +209,9 @@ public:
         // Get departure and arrival airport
         Airport* depart = vertexes.at(code_depart);
         Airport* arrive = vertexes.at(code_arrive);
-        // Increment appropriate counters for both airports
-        depart->inc_outgoing();
-        arrive->inc_incoming();
+        // Count the flight for both airports
+        degrees.add_flight(code_depart, code_arrive);
+        adjacency.invalidate();
         // Add flight to airport
         depart->add_flight(code_arrive, arrive, distance, cost);
     }
@@ -208,32 +220,17 @@ public:
         return contains(vertexes, code);
     }
 
-    // Simplified edge struct for use in flight_connections function
-    struct MiniEdge {
-        string code;
-        int connections;
-
-        MiniEdge(string code, int connections) : code(std::move(code)), connections(connections) {}
-    };
-
-    // Comparison function for std::sort
-    static bool compareMiniEdge(const MiniEdge& lhs, const MiniEdge& rhs) {
-        return lhs.connections > rhs.connections;
+    // Displays the number of flights in and out of each airport in descending order
+    void flight_connections() const {
+        flight_connections(degrees.size());
     }
 
-    // Counts the number of flights in and out of each airport and displays them in descending order
-    void flight_connections() {
-        vector<MiniEdge> v;
+    // Displays the number of flights in and out of the k most connected airports in descending order
+    // Reads from the degree index so no sorting is done here
+    void flight_connections(size_t k) const {
         std::cout << "Airport\tConnections" << std::endl;
-        // Place each code, num connections pair in a vector
-        for (const auto& airport: vertexes) {
-            v.emplace_back(airport.first, airport.second->total_flights());
-        }
-        // Sort the vector descending
-        std::sort(v.begin(), v.end(), compareMiniEdge);
-        // Print each pair in order
-        for (const MiniEdge& edge: v) {
-            std::cout << edge.code << "\t" << edge.connections << std::endl;
+        for (const auto& degree: degrees.top(k)) {
+            std::cout << degree.code << "\t" << degree.total() << std::endl;
         }
     }
 
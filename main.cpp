@@ -1,6 +1,7 @@
 #include "graph.h"
 #include "pathing.h"
 #include "tree.h"
+#include "apsp.h"
 
 int main() {
     auto g = Graph("airports.csv"); // Task 1
@@ -19,5 +20,10 @@ int main() {
     prim.print();
     kruskal.print();
 
+    // Tasks 2 and 3 answered by table lookup instead of a search
+    auto table = PathTable::build(g); // all pairs shortest paths
+    table.from("IAD").to("MIA"); // Task 2
+    table.from("ATL").to_state("FL"); // Task 3
+
     return 0;
 }
\ No newline at end of file
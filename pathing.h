@@ -8,6 +8,8 @@
 #include <vector>
 #include <iostream>
 #include <unordered_map>
+#include <queue>
+#include <functional>
 #include "graph.h"
 #include "util.h"
 
@@ -108,47 +110,150 @@ struct Paths {
     }
 };
 
-// Run Dijkstra-like shortest-path search from 'from' over Graph g
-Paths find_paths_from(const Graph& g, const string& from) {
-    unordered_map<string, int> dist;         // distance labels
-    unordered_map<string, int> cost;         // cost labels
-    unordered_map<string, bool> visited;     // visited flag per node
-    unordered_map<string, string> prev;      // predecessor map
+// Holds the results of a shortest-path search into a single destination
+// Mirrors Paths, but walks next[] toward the destination instead of prev[] back to an origin
+struct InboundPaths {
+    string to;                                         // destination airport code
+    unordered_map<string, vector<Airport*>> by_state;  // map state code → list of airports in that state
+    unordered_map<string, int> dist;                   // best-known distance from each code to destination
+    unordered_map<string, int> cost;                   // best-known cost from each code to destination
+    unordered_map<string, string> next;                // next-hop map for path reconstruction
 
-    // initialize all maps: origin=0, others=INF
-    for (const auto& vertex: g.get_vertexes()) {
-        dist.insert({vertex.first, vertex.first == from ? 0 : INF});
-        cost.insert({vertex.first, vertex.first == from ? 0 : INF});
-        visited.insert({vertex.first, false});
-    }
+    // construct with precomputed maps (moved in for efficiency)
+    InboundPaths(string to,
+                 unordered_map<string, vector<Airport*>> by_state,
+                 unordered_map<string, int> dist,
+                 unordered_map<string, int> cost,
+                 unordered_map<string, string> next)
+            : to(std::move(to)),
+              by_state(std::move(by_state)),
+              dist(std::move(dist)),
+              cost(std::move(cost)),
+              next(std::move(next)) {}
 
-    size_t unvisited = dist.size();          // count how many remain
-    string current = from;                   // start at origin
+    // Print the single shortest path from the given airport code to the destination
+    void from(const string& from) {
+        Path p;
+        p.distance = dist[from];              // retrieve distance
+        p.cost = cost[from];                  // retrieve cost
+        string code = from;
+        p.path.push_back(code);               // path is built in order, no reverse needed
+        while (contains(next,code)) {         // walk forward through next[] until destination
+            code = next[code];
+            p.path.push_back(code);
+        }
+        if (p.path.size() == 1) {             // no path found (only origin itself)
+            std::cout << "Shortest route from " << from << " to " << to << ": None" << std::endl;
+            return;
+        }
+        std::cout << "Shortest route from " << from << " to " << to << ": ";
+        p.print_path();
+        std::cout << ". The length is " << p.distance << ". The cost is " << p.cost << "." << std::endl;
+    }
 
-    while (current != "") {                  // loop until no unvisited reachable node
-        for (const auto& edge: g.get_vertexes()[current]->get_edges()) {
-            if (!visited[edge.first] && (dist[current] + edge.second->get_distance()) < dist[edge.first]) {
-                dist[edge.first] = dist[current] + edge.second->get_distance();  // relax by distance
-                cost[edge.first] = cost[current] + edge.second->get_cost();      // relax by cost
-                prev[edge.first] = current;                                // record predecessor
+    // Print all shortest paths from airports in the given state code to the destination
+    unordered_map<string, Path> from_state(const string& from) {
+        unordered_map<string, Path> out;
+        std::cout << "The shortest paths from " << from << " state airports to " << to << " are:" << std::endl;
+        std::cout << std::endl << "Path\tLength\tCost" << std::endl;
+        for (const Airport* airport: by_state[from]) {  // iterate airports in that state
+            string code = airport->get_code();
+            Path p;
+            p.distance = dist[code];                // set distance
+            p.cost = cost[code];                    // set cost
+            p.path.push_back(code);                 // build forward path
+            while (contains(next,code)) {
+                code = next[code];
+                p.path.push_back(code);
             }
+            if (p.path.size() == 1) continue;       // skip unreachable airports
+            p.print_path();
+            std::cout << "\t" << p.distance << "\t" << p.cost << std::endl;
+            out.insert({airport->get_code(), p});
         }
-        visited[current] = true;             // mark done
-        unvisited--;
-        string u;
-        int u_min = INF;
-        // find next unvisited with smallest dist (no priority queue used)
-        for (const auto& item: dist) {
-            if (item.second < u_min && !g.get_vertexes()[item.first]->is_terminal() && !visited[item.first]) {
-                u = item.first;
-                u_min = item.second;
+        return out;                                 // return map of code→Path
+    }
+};
+
+// Shortest-path tree over vertex indexes of an Adjacency
+// parent is the previous hop on a forward search and the next hop on a reverse search, -1 at the root or if unreachable
+struct SearchTree {
+    vector<int> dist;
+    vector<int> cost;
+    vector<int> parent;
+};
+
+// Dijkstra search by distance from a single root over either CSR of an Adjacency
+// Searching the reverse CSR gives the shortest path from every airport into the root
+SearchTree shortest_path_tree(const Csr& csr, int root) {
+    size_t n = csr.offsets.size() - 1;
+    SearchTree t;
+    t.dist.assign(n, INF);
+    t.cost.assign(n, INF);
+    t.parent.assign(n, -1);
+    vector<bool> visited(n, false);
+    // min-heap of (distance, vertex index)
+    std::priority_queue<std::pair<int, int>, vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> queue;
+    t.dist[root] = 0;
+    t.cost[root] = 0;
+    queue.push({0, root});
+
+    while (!queue.empty()) {
+        int u = queue.top().second;
+        queue.pop();
+        if (visited[u]) continue;           // stale queue entry
+        visited[u] = true;
+        for (int e = csr.offsets[u]; e < csr.offsets[u + 1]; e++) {
+            int v = csr.targets[e];
+            if (!visited[v] && t.dist[u] + csr.distance[e] < t.dist[v]) {
+                t.dist[v] = t.dist[u] + csr.distance[e];  // relax by distance
+                t.cost[v] = t.cost[u] + csr.cost[e];      // relax by cost
+                t.parent[v] = u;                          // record predecessor (or successor)
+                queue.push({t.dist[v], v});
             }
         }
-        current = u;                         // move to next node or "" if none remain
     }
+    return t;
+}
+
+// Converts a search tree from index form into the code keyed maps used by Paths and InboundPaths
+void unpack_tree(const Adjacency& adj, const SearchTree& t,
+                 unordered_map<string, int>& dist,
+                 unordered_map<string, int>& cost,
+                 unordered_map<string, string>& parent) {
+    for (size_t i = 0; i < adj.size(); i++) {
+        const string& code = adj.code_of(static_cast<int>(i));
+        dist.insert({code, t.dist[i]});
+        cost.insert({code, t.cost[i]});
+        if (t.parent[i] != -1) {
+            parent.insert({code, adj.code_of(t.parent[i])});
+        }
+    }
+}
+
+// Run Dijkstra shortest-path search from 'from' over Graph g
+Paths find_paths_from(const Graph& g, const string& from) {
+    unordered_map<string, int> dist;         // distance labels
+    unordered_map<string, int> cost;         // cost labels
+    unordered_map<string, string> prev;      // predecessor map
+
+    const Adjacency& adj = g.get_adjacency();
+    unpack_tree(adj, shortest_path_tree(adj.get_forward(), adj.index_of(from)), dist, cost, prev);
     return {from, g.get_states(), dist, cost, prev};  // package results
 }
 
+// Run Dijkstra shortest-path search from every airport into 'to' over Graph g
+// One search over the reverse adjacency instead of one forward search per origin
+InboundPaths find_paths_to(const Graph& g, const string& to) {
+    unordered_map<string, int> dist;         // distance labels
+    unordered_map<string, int> cost;         // cost labels
+    unordered_map<string, string> next;      // successor map
+
+    const Adjacency& adj = g.get_adjacency();
+    unpack_tree(adj, shortest_path_tree(adj.get_reverse(), adj.index_of(to)), dist, cost, next);
+    return {to, g.get_states(), dist, cost, next};  // package results
+}
+
 // Run constrained shortest-path search with exactly 'stops' allowed
 void find_path_with_n_stops(const Graph& g, const string& from, const string& to, int stops) {
     unordered_map<string, int> dist;      // distance labels